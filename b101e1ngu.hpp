@@ -19,6 +19,9 @@ struct b101e1ngu : iboard {
     void reset(bool flash_boot);
     void start();
     void load(const std::string& path, int argc, char* argv[]);
+    void load_staged(const std::string& stub, const std::string& path,
+                     int argc, char* argv[]);
+    void enable_stream(bool enable);
     struct board_impl;
 private:
     boost::shared_ptr<board_impl> pimpl_;
@@ -0,0 +1,106 @@
+#ifndef BRD_B101E1NGU_REGS_HPP
+#define BRD_B101E1NGU_REGS_HPP
+
+#include <cstdint>
+
+#include "bus_address.hpp"
+#include "bus_packet.hpp"
+
+namespace brd { namespace board { namespace b101e1ngu_regs {
+
+enum bus_type {
+    HOST_BUS = 0x2,
+    PROC_BUS = 0x3,
+
+};
+
+enum processor_addrs {
+    PROCESSOR_BASE = 0x2000000,
+    SYSCON	= PROCESSOR_BASE + 0x00180480,
+    SDRCON	= PROCESSOR_BASE + 0x00180484,      // SDRAM CONFIG REG
+    VIRPT   = PROCESSOR_BASE + 0x00180730,
+
+};
+
+enum hostpld_addrs {
+    HMODE   = 0x00000000,
+    HSTATUS = 0x00000004,
+    HMASK   = 0x0000000C,
+    SEM0    = 0x0000001C,
+    MSG_ADR = 0x00000080,
+};
+
+enum hmode_flags {
+    HMODE_DMA0EN	= 0x01000000, // DMA0 request enable (FIFO2 - read)
+    HMODE_DMA1EN	= 0x02000000, // DMA1 request enable (FIFO1 - write)
+    HMODE_RESFIFO2	= 0x04000000, // FIFO2 reset
+    HMODE_RESFIFO1	= 0x08000000, // FIFO1 reset
+    HMODE_RESET		= 0x10000000, // BOARD RESET
+    HMODE_FLASH		= 0x20000000, // BOARD FLASH LOAD
+    HMODE_ERR_CLR 	= 0x80000000  // reset for host error bit
+};
+
+enum hmask_flags {
+    HMASK_MMSG8    = 0x00000001,  // MSG[8] interrupt enable
+    HMASK_MMSG9    = 0x00000002,  // MSG[9] interrupt enable
+    HMASK_MMSG10   = 0x00000004,  // MSG[10] interrupt enable
+    HMASK_MMSG11   = 0x00000008,  // MSG[11] interrupt enable
+    HMASK_MMSG12   = 0x00000010,  // MSG[12] interrupt enable
+    HMASK_MMSG13   = 0x00000020,  // MSG[13] interrupt enable
+    HMASK_MMSG14   = 0x00000040,  // MSG[14] interrupt enable
+    HMASK_MMSG15   = 0x00000080,  // MSG[15] interrupt enable
+    HMASK_M2EF     = 0x00000100,  // FIFO 2 (DSP->PC) empty interrupt enable
+    HMASK_M2HF     = 0x00000200,  // FIFO 2 (DSP->PC) half interrupt enable
+    HMASK_M2FF     = 0x00000400,  // FIFO 2 (DSP->PC) full interrupt enable
+    HMASK_M1EF     = 0x00000800,  // FIFO 1 (PC->DSP) empty interrupt enable
+    HMASK_M1HF     = 0x00001000,  // FIFO 1 (PC->DSP) half interrupt enable
+    HMASK_M1FF     = 0x00002000,  // FIFO 1 (PC->DSP) full interrupt enable
+    HMASK_M2ERROR  = 0x00004000,  // interrupt for error FIFO 2
+    HMASK_M1ERROR  = 0x00008000,  // interrupt for error FIFO 1
+    HMASK_MSEM0    = 0x00010000,  // interrupt for SEM0
+    HMASK_MSEM1    = 0x00020000,  // interrupt for SEM1
+    HMASK_MSEM2    = 0x00040000,  // interrupt for SEM2
+    HMASK_MSEM3    = 0x00080000,  // interrupt for SEM3
+    HMASK_MSEM4    = 0x00100000,  // interrupt for SEM4
+    HMASK_MSEM5    = 0x00200000,  // interrupt for SEM5
+    HMASK_MSEM6    = 0x00400000,  // interrupt for SEM6
+    HMASK_MSEM7    = 0x00800000,  // interrupt for SEM7
+    HMASK_M2PEF    = 0x01000000,  //
+    HMASK_M2PFF    = 0x02000000,  //
+    HMASK_M1PEF    = 0x04000000,  //
+    HMASK_M1PFF    = 0x08000000,  //
+    HMASK_MCNT_ERR = 0x80000000,  //
+};
+
+// A register with its single word requests encoded at compile time.
+template <uint32_t Bus, uint32_t Address>
+struct reg {
+    static constexpr uint32_t type = Bus;
+    static constexpr uint32_t value = Address;
+    static constexpr bus::packet_header read_header =
+        bus::make_header(bus::READMEM, Bus, Address, 1);
+    static constexpr bus::packet_header write_header =
+        bus::make_header(bus::WRITEMEM, Bus, Address, 1);
+
+    static bus::address address() { return bus::address(Bus, Address); }
+};
+
+template <uint32_t Bus, uint32_t Address>
+constexpr bus::packet_header reg<Bus, Address>::read_header;
+
+template <uint32_t Bus, uint32_t Address>
+constexpr bus::packet_header reg<Bus, Address>::write_header;
+
+typedef reg<HOST_BUS, HMODE>   hmode;
+typedef reg<HOST_BUS, HSTATUS> hstatus;
+typedef reg<HOST_BUS, HMASK>   hmask;
+typedef reg<HOST_BUS, SEM0>    sem0;
+typedef reg<HOST_BUS, MSG_ADR> msg_adr;
+
+typedef reg<PROC_BUS, SYSCON>  syscon;
+typedef reg<PROC_BUS, SDRCON>  sdrcon;
+typedef reg<PROC_BUS, VIRPT>   virpt;
+
+}}} //namespace brd::board::b101e1ngu_regs
+
+#endif //BRD_B101E1NGU_REGS_HPP
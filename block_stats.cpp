@@ -0,0 +1,185 @@
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include "block_stats.hpp"
+
+namespace brd { namespace capture {
+
+// The kernels keep the loops branch-free over contiguous samples so
+// that the compiler vectorizes them: the loop of summarize and the
+// inner loop of decimate, as g++ -O3 -fopt-info-vec reports.
+block_summary summarize(const int16_t* first, std::size_t count) {
+    block_summary summary = { 0, 0, 0.0, 0.0 };
+    if (!count)
+        return summary;
+
+    // min/max on the widened sample rather than through std::min,
+    // whose reference result keeps the loop from vectorizing
+    int32_t lo = first[0];
+    int32_t hi = first[0];
+    int64_t sum = 0;
+    int64_t squares = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        int32_t s = first[i];
+        lo = s < lo ? s : lo;
+        hi = s > hi ? s : hi;
+        sum += s;
+        squares += s*s;
+    }
+    summary.min = lo;
+    summary.max = hi;
+    summary.mean = static_cast<double>(sum)/count;
+    summary.rms = std::sqrt(static_cast<double>(squares)/count);
+    return summary;
+}
+
+std::size_t decimate(const int16_t* first, std::size_t count,
+                     std::size_t ratio, int16_t* out) {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < count; i += ratio, ++n) {
+        std::size_t len = std::min(ratio, count - i);
+        int64_t sum = 0;
+        for (std::size_t j = 0; j < len; ++j)
+            sum += first[i + j];
+        out[n] = static_cast<int16_t>(sum/static_cast<int64_t>(len));
+    }
+    return n;
+}
+
+// A record goes out whole or not at all: datagrams are limited to the
+// largest UDP payload and FIFO writes to PIPE_BUF, which the kernel
+// writes atomically.
+struct stats_writer::sink {
+    typedef boost::asio::ip::udp udp;
+
+    explicit sink(const std::string& target)
+        : fd_(-1)
+        , max_record_(65507)
+        , socket_(io_service_) {
+        const std::string scheme("udp://");
+        if (target.compare(0, scheme.size(), scheme) == 0) {
+            std::string address = target.substr(scheme.size());
+            std::size_t pos = address.rfind(':');
+            if (pos == std::string::npos)
+                throw stats_error("port is missing in " + target);
+            udp::resolver resolver(io_service_);
+            udp::resolver::query query(udp::v4(), address.substr(0, pos),
+                                       address.substr(pos + 1));
+            socket_.open(udp::v4());
+            socket_.connect(*resolver.resolve(query));
+            socket_.non_blocking(true);
+        } else {
+            // a FIFO is opened read-write so that opening doesn't wait
+            // for a reader, records written before one appears are
+            // dropped once the pipe is full
+            struct stat st;
+            bool fifo = ::stat(target.c_str(), &st) == 0 &&
+                        S_ISFIFO(st.st_mode);
+            fd_ = ::open(target.c_str(), O_NONBLOCK |
+                         (fifo ? O_RDWR : O_WRONLY | O_CREAT | O_TRUNC),
+                         0644);
+            if (fd_ < 0)
+                throw stats_error(target + ": " + std::strerror(errno));
+            max_record_ = fifo ? PIPE_BUF : 0;
+        }
+    }
+
+    ~sink() {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    bool send(const std::vector<char>& record) {
+        if (fd_ < 0) {
+            boost::system::error_code ec;
+            socket_.send(boost::asio::buffer(record), 0, ec);
+            return !ec;
+        }
+        ssize_t n = ::write(fd_, &record[0], record.size());
+        if (n < 0 && errno != EAGAIN && errno != EPIPE)
+            throw stats_error(std::strerror(errno));
+        return n == static_cast<ssize_t>(record.size());
+    }
+
+    // largest record sent whole, 0 if unlimited
+    std::size_t max_record() const { return max_record_; }
+private:
+    int fd_;
+    std::size_t max_record_;
+    boost::asio::io_service io_service_;
+    udp::socket socket_;
+};
+
+stats_writer::stats_writer(const std::string& target, std::size_t block,
+                           std::size_t ratio)
+    : sink_(new sink(target))
+    , ratio_(ratio)
+    , block_(block)
+    , filled_(0)
+    , sequence_(0)
+    , dropped_(0) {
+    if (block == 0 || ratio == 0)
+        throw stats_error("block size and decimation must be positive");
+    std::size_t size = sizeof(stats_header) +
+                       (block + ratio - 1)/ratio*sizeof(sample_type);
+    if (sink_->max_record() && size > sink_->max_record())
+        throw stats_error(std::to_string(size) + " byte records exceed " +
+                          std::to_string(sink_->max_record()) +
+                          " bytes, raise the decimation or "
+                          "shrink the block");
+    record_.reserve(size);
+}
+
+void stats_writer::process(const char* data, std::size_t size,
+                           const timespec& stamp) {
+    const std::size_t capacity = block_.size()*sizeof(sample_type);
+    char* buffer = reinterpret_cast<char*>(&block_[0]);
+    while (size) {
+        if (!filled_)
+            stamp_ = stamp;
+        std::size_t n = std::min(size, capacity - filled_);
+        std::memcpy(buffer + filled_, data, n);
+        filled_ += n;
+        data += n;
+        size -= n;
+        if (filled_ == capacity)
+            flush();
+    }
+}
+
+void stats_writer::flush() {
+    const std::size_t count = block_.size();
+    block_summary summary = summarize(&block_[0], count);
+
+    stats_header header;
+    header.magic = stats_header::signature;
+    header.sequence = sequence_++;
+    header.sec = stamp_.tv_sec;
+    header.nsec = stamp_.tv_nsec;
+    header.samples = count;
+    header.min = summary.min;
+    header.max = summary.max;
+    header.mean = summary.mean;
+    header.rms = summary.rms;
+    header.preview = (count + ratio_ - 1)/ratio_;
+
+    record_.resize(sizeof(header) + header.preview*sizeof(sample_type));
+    std::memcpy(&record_[0], &header, sizeof(header));
+    decimate(&block_[0], count, ratio_,
+             reinterpret_cast<sample_type*>(&record_[sizeof(header)]));
+    if (!sink_->send(record_))
+        ++dropped_;
+    filled_ = 0;
+}
+
+}} //namespace brd::capture
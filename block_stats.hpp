@@ -0,0 +1,80 @@
+#ifndef BRD_BLOCK_STATS_HPP
+#define BRD_BLOCK_STATS_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace brd { namespace capture {
+
+struct stats_error : std::runtime_error {
+    stats_error(const std::string& what_arg) throw()
+        : std::runtime_error("stats: " + what_arg) {}
+};
+
+// Summary record of one block, followed by `preview` 16-bit samples
+// of the block decimated by boxcar averaging.
+struct stats_header {
+    static const uint32_t signature = 0x54415453; // "STAT"
+
+    uint32_t magic;
+    uint32_t sequence;
+    uint64_t sec;
+    uint32_t nsec;
+    uint32_t samples;
+    int16_t min;
+    int16_t max;
+    float mean;
+    float rms;
+    uint32_t preview;
+};
+
+struct block_summary {
+    int16_t min;
+    int16_t max;
+    double mean;
+    double rms;
+};
+
+block_summary summarize(const int16_t* first, std::size_t count);
+
+std::size_t decimate(const int16_t* first, std::size_t count,
+                     std::size_t ratio, int16_t* out);
+
+// Computes per-block statistics and a decimated preview of the stream
+// and emits them to a low-rate side channel. `target` is a file or
+// FIFO path, or udp://host:port. The side channel never blocks the
+// capture, records it can't take are dropped whole and counted.
+// Records are 40 + 2*ceil(block/ratio) bytes, a configuration whose
+// records exceed a FIFO's PIPE_BUF or a UDP datagram is rejected.
+struct stats_writer : boost::noncopyable {
+    typedef int16_t sample_type;
+
+    stats_writer(const std::string& target, std::size_t block,
+                 std::size_t ratio);
+
+    void process(const char* data, std::size_t size, const timespec& stamp);
+
+    uint32_t dropped() const { return dropped_; }
+    struct sink;
+private:
+    void flush();
+private:
+    boost::shared_ptr<sink> sink_;
+    std::size_t ratio_;
+    std::vector<sample_type> block_;
+    std::size_t filled_; // bytes
+    std::vector<char> record_;
+    timespec stamp_;
+    uint32_t sequence_;
+    uint32_t dropped_;
+};
+
+}} //namespace brd::capture
+
+#endif //BRD_BLOCK_STATS_HPP
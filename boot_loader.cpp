@@ -18,17 +18,57 @@ void load_code(const bus::address& proc, bus::bus_ptr bus,
 void load_args(const bus::address& proc, bus::bus_ptr bus, 
                const elf::elfio& executable, int argc, char* argv[]);
 
-void load(const bus::address& proc, bus::bus_ptr bus, 
-          const std::string& path, int argc, char* argv[]) {
-    elf::elfio executable;
+void load_executable(const std::string& path, elf::elfio& executable) {
     if (!executable.load(path)) {
         throw boot_error("can't find or process ELF file " + path);
     }
+}
+
+void load(const bus::address& proc, bus::bus_ptr bus, 
+          const std::string& path, int argc, char* argv[]) {
+    elf::elfio executable;
+    load_executable(path, executable);
 
     load_code(proc, bus, executable);
     load_args(proc, bus, executable, argc, argv);
 }
 
+void load_stub(const bus::address& proc, bus::bus_ptr bus,
+               const std::string& path) {
+    elf::elfio executable;
+    load_executable(path, executable);
+
+    load_code(proc, bus, executable);
+}
+
+void load_stream(const bus::address& proc, bus::bus_ptr bus,
+                 stream_loader& loader, const std::string& path,
+                 int argc, char* argv[]) {
+    typedef bus::ibus::value_type value_type;
+    elf::elfio executable;
+    load_executable(path, executable);
+
+    std::vector< std::vector<value_type> > sections;
+    std::vector<segment> image;
+    sections.reserve(executable.sections.size());
+    for (int i = 0; i < executable.sections.size(); ++i) {
+        const elf::section* psec = executable.sections[i];
+        if (psec->get_type() == SHT_PROGBITS && psec->get_size()) {
+            assert(psec->get_size()%sizeof(value_type) == 0);
+            sections.push_back(std::vector<value_type>(
+                reinterpret_cast<const value_type*>(psec->get_data()),
+                reinterpret_cast<const value_type*>(psec->get_data() +
+                                                    psec->get_size())));
+            const std::vector<value_type>& data = sections.back();
+            image.push_back(segment(psec->get_address(),
+                                    &data[0], &data[0] + data.size()));
+        }
+    }
+
+    loader.load(proc, image);
+    load_args(proc, bus, executable, argc, argv);
+}
+
 template <typename Iterator>
 typename std::iterator_traits<Iterator>::difference_type
 mismatch_index(Iterator first1, Iterator last1, Iterator first2) {
@@ -4,6 +4,7 @@
 #include <string>
 #include <stdexcept>
 #include "ibus.hpp"
+#include "boot_stream.hpp"
 
 namespace brd { namespace boot {
 
@@ -30,6 +31,16 @@ struct symbol_not_found : boot_error {
 void load(const bus::address& proc, bus::bus_ptr bus, 
           const std::string& path, int argc = 0, char* argv[] = 0);
 
+// loads only the code of the resident loader stub through the bus
+void load_stub(const bus::address& proc, bus::bus_ptr bus,
+               const std::string& path);
+
+// sends the code to the running stub over the stream channel,
+// the arguments are written through the bus
+void load_stream(const bus::address& proc, bus::bus_ptr bus,
+                 stream_loader& loader, const std::string& path,
+                 int argc = 0, char* argv[] = 0);
+
 
 }} //namespce brd::boot
 
@@ -0,0 +1,193 @@
+#include <algorithm>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include "boot_stream.hpp"
+#include "boot_loader.hpp"
+
+namespace brd { namespace boot {
+
+uint32_t checksum(const uint32_t* first, const uint32_t* last, uint32_t sum) {
+    for (; first != last; ++first)
+        sum = ((sum << 1) | (sum >> 31)) + *first;
+    return sum;
+}
+
+std::size_t encode(const uint32_t* first, const uint32_t* last,
+                   std::size_t limit, std::vector<uint32_t>& out) {
+    const uint32_t run_flag = 0x80000000;
+    const std::size_t max_count = run_flag - 1;
+    const uint32_t* p = first;
+    while (p != last && limit >= 2) {
+        std::size_t run = 1;
+        while (p + run != last && p[run] == *p && run < max_count)
+            ++run;
+        if (run >= 3) {
+            out.push_back(run_flag | run);
+            out.push_back(*p);
+            p += run;
+            limit -= 2;
+            continue;
+        }
+
+        const std::size_t max_literal = std::min(limit - 1, max_count);
+        std::size_t n = 0;
+        while (p + n != last && n < max_literal) {
+            if (last - (p + n) >= 3 && p[n] == p[n + 1] && p[n] == p[n + 2])
+                break;
+            ++n;
+        }
+        out.push_back(n);
+        out.insert(out.end(), p, p + n);
+        p += n;
+        limit -= n + 1;
+    }
+    return p - first;
+}
+
+struct stream_loader::loader_impl {
+    typedef boost::asio::io_service io_service;
+    typedef boost::asio::deadline_timer deadline_timer;
+    typedef boost::asio::ip::udp udp;
+    typedef boost::posix_time::time_duration time_duration;
+
+    static const std::size_t max_packet_words = 368; // 1472 byte datagram
+    static const int max_retries = 50;
+
+    loader_impl(const std::string& host, unsigned short port,
+                std::size_t window,
+                time_duration timeout = boost::posix_time::milliseconds(100))
+        : socket_(io_service_, udp::v4())
+        , window_(window)
+        , timeout_(timeout)
+        , deadline_(io_service_) {
+        udp::resolver resolver(io_service_);
+        udp::resolver::query query(udp::v4(), host,
+                                   boost::lexical_cast<std::string>(port));
+        socket_.connect(*resolver.resolve(query));
+        check_deadline();
+    }
+
+    void load(const bus::address& proc, const std::vector<segment>& image) {
+        std::vector< std::vector<uint32_t> > packets;
+        uint32_t total = 0;
+        uint32_t sum = 0;
+        for (std::size_t i = 0; i < image.size(); ++i) {
+            const uint32_t* p = image[i].first;
+            while (p != image[i].last) {
+                std::vector<uint32_t> packet(header_words);
+                std::size_t n = encode(p, image[i].last,
+                                       max_packet_words - header_words,
+                                       packet);
+                packet_header header;
+                header.magic = packet_header::signature;
+                header.sequence = packets.size();
+                header.command = packet_header::DATA;
+                header.address = proc.value() + image[i].address +
+                                 (p - image[i].first);
+                header.words = n;
+                header.encoded = packet.size() - header_words;
+                header.checksum = checksum(p, p + n);
+                std::copy(reinterpret_cast<const uint32_t*>(&header),
+                          reinterpret_cast<const uint32_t*>(&header + 1),
+                          packet.begin());
+                packets.push_back(packet);
+
+                sum = checksum(p, p + n, sum);
+                total += n;
+                p += n;
+            }
+        }
+
+        packet_header done = { packet_header::signature,
+                               static_cast<uint32_t>(packets.size()),
+                               packet_header::DONE, proc.value(),
+                               total, 0, sum };
+        packets.push_back(
+            std::vector<uint32_t>(reinterpret_cast<const uint32_t*>(&done),
+                                  reinterpret_cast<const uint32_t*>(&done + 1)));
+        transfer(packets);
+    }
+private:
+    static const std::size_t header_words =
+        sizeof(packet_header)/sizeof(uint32_t);
+
+    // go-back-N over cumulative acknowledgements
+    void transfer(const std::vector< std::vector<uint32_t> >& packets) {
+        std::size_t base = 0;
+        std::size_t next = 0;
+        int retries = 0;
+        while (base < packets.size()) {
+            for (; next < packets.size() && next < base + window_; ++next)
+                socket_.send(boost::asio::buffer(packets[next]));
+
+            ack_header ack;
+            boost::system::error_code ec;
+            std::size_t size = receive(boost::asio::buffer(&ack, sizeof(ack)),
+                                       ec);
+            bool accepted = !ec && size == sizeof(ack) &&
+                            ack.magic == packet_header::signature;
+            if (accepted && ack.sequence > base && ack.sequence <= next) {
+                base = ack.sequence;
+                retries = 0;
+            }
+            if (!accepted || ack.status) {
+                if (++retries > max_retries)
+                    throw boot_error(ec ? "stream loader timeout" :
+                                          "stream loader checksum error");
+                next = base;
+            }
+        }
+    }
+
+    void check_deadline() {
+        if (deadline_.expires_at() <= deadline_timer::traits_type::now()) {
+            socket_.cancel();
+            deadline_.expires_at(boost::posix_time::pos_infin);
+        }
+
+        deadline_.async_wait(boost::bind(&loader_impl::check_deadline, this));
+    }
+
+    std::size_t receive(const boost::asio::mutable_buffer& buffer,
+                        boost::system::error_code& ec) {
+        deadline_.expires_from_now(timeout_);
+        ec = boost::asio::error::would_block;
+        std::size_t length = 0;
+
+        socket_.async_receive(boost::asio::buffer(buffer),
+                              boost::bind(&loader_impl::handle_receive, _1, _2,
+                                          &ec, &length));
+
+        do io_service_.run_one(); while (ec == boost::asio::error::would_block);
+        return length;
+    }
+
+    static void handle_receive(const boost::system::error_code& ec,
+                               std::size_t length,
+                               boost::system::error_code* out_ec,
+                               std::size_t* out_length) {
+        *out_ec = ec;
+        *out_length = length;
+    }
+private:
+    io_service io_service_;
+    udp::socket socket_;
+    std::size_t window_;
+    time_duration timeout_;
+    deadline_timer deadline_;
+};
+
+stream_loader::stream_loader(const std::string& host, unsigned short port,
+                             std::size_t window)
+    : pimpl_(new loader_impl(host, port, window)) {}
+void stream_loader::load(const bus::address& proc,
+                         const std::vector<segment>& image) {
+    pimpl_->load(proc, image);
+}
+
+}} //namespace brd::boot
@@ -0,0 +1,83 @@
+#ifndef BRD_BOOT_STREAM_HPP
+#define BRD_BOOT_STREAM_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "bus_address.hpp"
+
+namespace brd { namespace boot {
+
+// Second boot stage protocol, spoken with the resident loader stub
+// over the stream channel. All fields are 32-bit words.
+//
+// The host sends packet_header + `encoded` payload words. A DATA
+// packet carries `words` image words starting at `address`, run-length
+// encoded: a token with the high bit set is followed by one word
+// repeated (token & 0x7fffffff) times, any other token is followed
+// by `token` literal words. The last packet is DONE with `words` set
+// to the image size and `checksum` over the whole decoded image.
+//
+// The stub answers every packet with an ack_header whose `sequence`
+// is the next sequence number it expects, and applies packets only in
+// order. A nonzero status reports a checksum mismatch of the packet
+// `sequence` refers to. Once DONE is acknowledged with zero status the
+// image is in memory and the stub waits for the start interrupt.
+struct packet_header {
+    static const uint32_t signature = 0x544F4F42; // "BOOT"
+
+    enum command {
+        DATA = 1,
+        DONE = 2
+    };
+
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t command;
+    uint32_t address;
+    uint32_t words;
+    uint32_t encoded;
+    uint32_t checksum;
+};
+
+struct ack_header {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t status;
+};
+
+uint32_t checksum(const uint32_t* first, const uint32_t* last,
+                  uint32_t sum = 0);
+
+// Encodes words from [first, last) into at most `limit` words appended
+// to `out`, returns the number of input words consumed.
+std::size_t encode(const uint32_t* first, const uint32_t* last,
+                   std::size_t limit, std::vector<uint32_t>& out);
+
+struct segment {
+    segment(uint32_t address, const uint32_t* first, const uint32_t* last)
+        : address(address)
+        , first(first)
+        , last(last) {}
+
+    uint32_t address;
+    const uint32_t* first;
+    const uint32_t* last;
+};
+
+struct stream_loader {
+    stream_loader(const std::string& host, unsigned short port,
+                  std::size_t window = 32);
+
+    void load(const bus::address& proc, const std::vector<segment>& image);
+    struct loader_impl;
+private:
+    boost::shared_ptr<loader_impl> pimpl_;
+};
+
+}} //namespace brd::boot
+
+#endif //BRD_BOOT_STREAM_HPP
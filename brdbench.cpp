@@ -0,0 +1,236 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <new>
+#include <thread>
+#include <chrono>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "udp_bus.hpp"
+#include "bus_packet.hpp"
+#include "b101e1ngu_regs.hpp"
+
+// Microbenchmark of the bus client against a responder on loopback,
+// reports time, client CPU and heap allocations per request.
+
+namespace impl {
+
+unsigned long allocations = 0;
+
+}
+
+void* operator new(std::size_t size) {
+    ++impl::allocations;
+    void* p = std::malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace impl {
+
+namespace bus = brd::bus;
+
+// Answers READMEM/WRITEMEM requests from a local memory image the way
+// the board does and echoes anything else, e.g. the capture spell.
+struct responder {
+    responder()
+        : fd_(::socket(AF_INET, SOCK_DGRAM, 0))
+        , memory_(1 << 20) {
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (fd_ < 0 ||
+            ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), len) < 0 ||
+            ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) < 0)
+            throw std::runtime_error(std::string("responder: ") +
+                                     std::strerror(errno));
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread(&responder::run, this);
+    }
+
+    ~responder() {
+        ::shutdown(fd_, SHUT_RDWR);
+        thread_.join();
+        ::close(fd_);
+    }
+
+    unsigned short port() const { return port_; }
+private:
+    void run() {
+        bus::packet p;
+        for (;;) {
+            sockaddr_in peer;
+            socklen_t len = sizeof(peer);
+            ssize_t n = ::recvfrom(fd_, &p, sizeof(p), 0,
+                                   reinterpret_cast<sockaddr*>(&peer), &len);
+            if (n <= 0)
+                return;
+            if (static_cast<std::size_t>(n) >= p.bytes(0) &&
+                bus::from_wire(p.header.word[0]) == bus::packet_signature) {
+                std::size_t words = bus::from_wire(p.header.word[4])/
+                                    sizeof(uint32_t);
+                std::size_t first = p.address() % (memory_.size() - words);
+                if (p.command() == bus::READMEM) {
+                    p.encode(p.header, &memory_[first], words);
+                    n = p.bytes(words);
+                } else {
+                    p.decode(&memory_[first], words);
+                    n = p.bytes(0);
+                }
+            }
+            ::sendto(fd_, &p, n, 0, reinterpret_cast<sockaddr*>(&peer), len);
+        }
+    }
+private:
+    int fd_;
+    unsigned short port_;
+    std::vector<uint32_t> memory_;
+    std::thread thread_;
+};
+
+double cpu_time() {
+    rusage usage;
+    ::getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec*1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec*1e-6;
+}
+
+// runs `count` iterations of `f` and prints the cost of one
+template <typename F>
+void measure(const std::string& name, std::size_t count, F f) {
+    unsigned long allocated = allocations;
+    double cpu = cpu_time();
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i)
+        f(i);
+    std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - start;
+    std::cout << name << ": "
+              << wall.count()/count*1e6 << " us, cpu "
+              << (cpu_time() - cpu)/count*1e6 << " us, allocations "
+              << static_cast<double>(allocations - allocated)/count
+              << std::endl;
+}
+
+volatile uint32_t sink;
+
+// makes the object behind `p` observable, so that the code building
+// it is not optimized away
+inline void escape(const void* p) {
+    asm volatile("" : : "r"(p) : "memory");
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        namespace fs = boost::filesystem;
+        namespace po = boost::program_options;
+        namespace bus = brd::bus;
+        namespace regs = brd::board::b101e1ngu_regs;
+
+        fs::path path(argv[0]);
+        std::string program_name(path.filename().string());
+
+        po::options_description
+            desc("Usage: " + program_name + " [options]");
+        std::size_t count;
+        std::size_t words;
+        desc.add_options()
+            ("help,h", "produce help message")
+            ("count,n", po::value<std::size_t>(&count)->default_value(200000),
+             "single word requests per run")
+            ("words", po::value<std::size_t>(&words)->default_value(1 << 20),
+             "words per block transfer");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+        if (vm.count("help")) {
+            std::cerr << desc << std::endl;
+            std::exit(EXIT_SUCCESS);
+        }
+
+        // a write request and the buffer for its answer, encoded the
+        // way udp_bus did before the packet codec, then with it
+        impl::measure("encode write request, vectors", count*100,
+                      [](std::size_t i) {
+            std::vector<uint32_t> request(9);
+            request[0] = bus::packet_signature;
+            request[1] = bus::WRITEMEM;
+            request[2] = regs::HOST_BUS;
+            request[3] = i;
+            request[4] = sizeof(uint32_t);
+            request[5] = 0;
+            request[8] = i;
+            std::vector<uint32_t> answer(8);
+            impl::escape(&request[0]);
+            impl::escape(&answer[0]);
+        });
+        impl::measure("encode write request, packet", count*100,
+                      [](std::size_t i) {
+            bus::packet request;
+            uint32_t value = i;
+            request.encode(bus::make_header(bus::WRITEMEM, regs::HOST_BUS,
+                                            i, 1), &value, 1);
+            bus::packet answer;
+            impl::escape(&request);
+            impl::escape(&answer);
+        });
+        impl::measure("encode register write, packet", count*100,
+                      [](std::size_t i) {
+            bus::packet request;
+            uint32_t value = i;
+            request.encode(regs::hmode::write_header, &value, 1);
+            bus::packet answer;
+            impl::escape(&request);
+            impl::escape(&answer);
+        });
+
+        impl::responder responder;
+        bus::udp_bus udp("127.0.0.1", responder.port());
+        bus::address addr(regs::HOST_BUS, regs::HMODE);
+        for (std::size_t i = 0; i < 1000; ++i)
+            impl::sink = udp.read(addr);
+
+        impl::measure("read + write", count, [&](std::size_t i) {
+            udp.write(addr, udp.read(addr) + i);
+        });
+        impl::measure("register read + write", count, [&](std::size_t i) {
+            udp.write_register<regs::hmode>(udp.read_register<regs::hmode>() +
+                                            i);
+        });
+
+        std::vector<uint32_t> block(words);
+        bus::address first(regs::PROC_BUS, regs::PROCESSOR_BASE);
+        impl::measure("block write", 1, [&](std::size_t) {
+            udp.write_block(first, &block[0], block.size());
+        });
+        impl::measure("block read", 1, [&](std::size_t) {
+            udp.read_block(first, &block[0], block.size());
+        });
+    } catch(std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
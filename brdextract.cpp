@@ -0,0 +1,120 @@
+#include <cstdlib>
+#include <string>
+#include <iostream>
+#include <iomanip>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "recording.hpp"
+
+namespace impl {
+
+// seconds[.fraction] since the epoch, or +seconds[.fraction]
+// relative to `origin`
+timespec parse_time(const std::string& text, const timespec& origin) {
+    bool relative = !text.empty() && text[0] == '+';
+    std::string value = text.substr(relative ? 1 : 0);
+    std::size_t pos = value.find('.');
+    std::string fraction = (pos == std::string::npos ?
+                            "" : value.substr(pos + 1));
+    fraction.resize(9, '0');
+
+    timespec stamp;
+    stamp.tv_sec = boost::lexical_cast<time_t>(value.substr(0, pos));
+    stamp.tv_nsec = boost::lexical_cast<long>(fraction);
+    if (relative) {
+        stamp.tv_sec += origin.tv_sec;
+        stamp.tv_nsec += origin.tv_nsec;
+        if (stamp.tv_nsec >= 1000000000) {
+            stamp.tv_nsec -= 1000000000;
+            ++stamp.tv_sec;
+        }
+    }
+    return stamp;
+}
+
+std::ostream& print_time(std::ostream& os, const timespec& stamp) {
+    return os << stamp.tv_sec << '.'
+              << std::setw(9) << std::setfill('0') << stamp.tv_nsec
+              << std::setfill(' ');
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        namespace fs = boost::filesystem;
+        namespace po = boost::program_options;
+
+        fs::path path(argv[0]);
+        std::string program_name(path.filename().string());
+
+        po::options_description
+            desc("Usage: " + program_name + " [options] recording");
+        std::string recording;
+        std::string from;
+        std::string to;
+        desc.add_options()
+            ("help,h", "produce help message")
+            ("recording,r", po::value<std::string>(&recording),
+             "recording written by brdread --record")
+            ("from,f", po::value<std::string>(&from),
+             "start time, seconds since the epoch or +seconds "
+             "from the beginning of the recording")
+            ("to,t", po::value<std::string>(&to),
+             "end time, in the same format as --from")
+            ("info,i", "print time span and size of the recording");
+
+        po::positional_options_description p;
+        p.add("recording", 1);
+
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).
+                  positional(p).run(), vm);
+        po::notify(vm);
+        if (vm.count("help") || !vm.count("recording")) {
+            std::cerr << desc << std::endl;
+            std::exit(EXIT_SUCCESS);
+        }
+
+        brd::record::recording_reader reader(recording);
+        brd::record::record rec;
+        timespec origin = { 0, 0 };
+        reader.read(reader.begin(), rec);
+        if (rec.data)
+            origin = rec.stamp;
+
+        if (vm.count("info")) {
+            timespec last = origin;
+            reader.read(reader.last(), rec);
+            if (rec.data)
+                last = rec.stamp;
+            impl::print_time(std::cout << "begin: ", origin) << std::endl;
+            impl::print_time(std::cout << "end: ", last) << std::endl;
+            std::cout << "bytes: " << reader.end() << std::endl;
+            std::exit(EXIT_SUCCESS);
+        }
+
+        uint64_t offset = (vm.count("from") ?
+                           reader.seek(impl::parse_time(from, origin)) :
+                           reader.begin());
+        bool bounded = vm.count("to");
+        timespec end = bounded ? impl::parse_time(to, origin) : origin;
+        while (offset < reader.end() && std::cout) {
+            offset = reader.read(offset, rec);
+            if (!rec.data ||
+                (bounded && brd::record::earlier(end, rec.stamp)))
+                break;
+            std::cout.write(rec.data, rec.size);
+        }
+        if (!std::cout)
+            throw std::runtime_error("output stream error");
+    } catch(std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -15,14 +15,26 @@
 int main(int argc, char* argv[]) {
     try {
         namespace fs = boost::filesystem;
+        std::string stub;
+        if (argc > 2 && std::string(argv[1]) == "--stub") {
+            stub = argv[2];
+            argv[2] = argv[0];
+            argc -= 2;
+            argv += 2;
+        }
         if (argc < 2 || 
             std::string(argv[1]) == "-h" ||
             std::string(argv[1]) == "--help") {
             fs::path program(argv[0]);
             std::cout << "Usage: "
                       << program.filename()
-                      << " address[:port] [dxepath dxeargs...]"
-                      << std::endl;
+                      << " [--stub stubpath] address[:port] "
+                         "[dxepath dxeargs...]"
+                      << std::endl
+                      << "  --stub stubpath  boot in two stages: load the "
+                         "loader stub through the bus," << std::endl
+                      << "                   then the executable over "
+                         "the stream channel" << std::endl;
             std::exit(EXIT_SUCCESS);
         }
     
@@ -30,7 +42,10 @@ int main(int argc, char* argv[]) {
         bool flashboot = argc < 3;
         board->reset(flashboot);
         if (!flashboot) {
-            board->load(argv[2], argc - 3, argv + 3);
+            if (stub.empty())
+                board->load(argv[2], argc - 3, argv + 3);
+            else
+                board->load_staged(stub, argv[2], argc - 3, argv + 3);
             board->start();
         }
     } catch (std::exception& e) {
@@ -0,0 +1,129 @@
+#include <cstdlib>
+#include <string>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "udp_bus.hpp"
+#include "memory_snapshot.hpp"
+#include "b101e1ngu_regs.hpp"
+
+namespace impl {
+
+// accepts decimal or 0x prefixed hexadecimal values
+uint32_t parse_number(const std::string& text) {
+    std::size_t pos = 0;
+    unsigned long value = std::stoul(text, &pos, 0);
+    if (pos != text.size())
+        throw std::runtime_error("bad number " + text);
+    return value;
+}
+
+uint32_t parse_bus(const std::string& name) {
+    namespace regs = brd::board::b101e1ngu_regs;
+    if (name == "host")
+        return regs::HOST_BUS;
+    if (name == "proc")
+        return regs::PROC_BUS;
+    return parse_number(name);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        namespace fs = boost::filesystem;
+        namespace po = boost::program_options;
+
+        fs::path path(argv[0]);
+        std::string program_name(path.filename().string());
+
+        po::options_description
+            desc("Usage: " + program_name +
+                 " [options] address dump|diff|restore");
+        std::string address;
+        std::string command;
+        std::string bus_name;
+        std::string start;
+        std::string count;
+        std::string file;
+        uint32_t chunk;
+        std::size_t burst;
+        std::size_t depth;
+        desc.add_options()
+            ("help,h", "produce help message")
+            ("address,a", po::value<std::string>(&address),
+             "board address, host[:port], default port is 3001")
+            ("command,c", po::value<std::string>(&command),
+             "dump memory to a snapshot, diff memory against it "
+             "or restore it")
+            ("bus", po::value<std::string>(&bus_name)->default_value("proc"),
+             "bus: proc, host or a bus type number")
+            ("start,s", po::value<std::string>(&start),
+             "first address of the region to dump")
+            ("count,n", po::value<std::string>(&count),
+             "words to dump")
+            ("file,f", po::value<std::string>(&file),
+             "snapshot file")
+            ("chunk", po::value<uint32_t>(&chunk)->default_value(65536),
+             "words per chunk, the unit of resume, diff and restore")
+            ("resume", "continue an interrupted dump")
+            ("full", "restore every chunk, not only the changed ones")
+            ("burst", po::value<std::size_t>(&burst)->default_value(256),
+             "words per bus request")
+            ("depth", po::value<std::size_t>(&depth)->default_value(8),
+             "bus requests in flight");
+
+        po::positional_options_description p;
+        p.add("address", 1);
+        p.add("command", 1);
+
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).
+                  options(desc).
+                  positional(p).run(), vm);
+        po::notify(vm);
+        if (vm.count("help") || !vm.count("address") ||
+            !vm.count("command") || !vm.count("file")) {
+            std::cerr << desc << std::endl;
+            std::exit(EXIT_SUCCESS);
+        }
+
+        std::size_t pos = address.find(':');
+        std::string host = address.substr(0, pos);
+        unsigned short port = (pos == std::string::npos ? 3001 :
+            boost::lexical_cast<unsigned short>(address.substr(pos + 1)));
+        boost::shared_ptr<brd::bus::udp_bus> bus(
+            new brd::bus::udp_bus(host, port));
+        bus->set_burst(burst, depth);
+
+        if (command == "dump") {
+            if (!vm.count("start") || !vm.count("count"))
+                throw std::runtime_error("dump needs --start and --count");
+            brd::bus::address first(impl::parse_bus(bus_name),
+                                     impl::parse_number(start));
+            brd::mem::dump(bus, first, impl::parse_number(count), file,
+                           chunk, vm.count("resume"));
+        } else if (command == "diff") {
+            std::vector<brd::mem::block> blocks =
+                brd::mem::diff(bus, file, chunk);
+            for (std::size_t i = 0; i < blocks.size(); ++i)
+                std::cout << "0x" << std::hex << blocks[i].offset
+                          << " " << std::dec << blocks[i].count
+                          << std::endl;
+            return blocks.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+        } else if (command == "restore") {
+            uint32_t written = brd::mem::restore(bus, file, chunk,
+                                                 !vm.count("full"));
+            std::cerr << written << " words written" << std::endl;
+        } else {
+            throw std::runtime_error("unknown command " + command);
+        }
+    } catch(std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,4 +1,6 @@
 #include <cstdlib>
+#include <csignal>
+#include <ctime>
 #include <algorithm>
 #include <string>
 #include <iostream>
@@ -8,8 +10,16 @@
 #include <boost/tuple/tuple.hpp>
 #include <boost/asio.hpp>
 #include <boost/range.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "spell.hpp"
+#include "trigger.hpp"
+#include "block_stats.hpp"
+#include "stream_receiver.hpp"
+#include "recording.hpp"
+#include "flow_control.hpp"
+#include "low_latency.hpp"
+#include "b101e1ngu.hpp"
 
 namespace impl {
 using boost::asio::ip::udp;
@@ -34,6 +44,26 @@ void initialize_board_connection(udp::socket& sock, int try_count = 10) {
         throw std::runtime_error("board initialization fail");
 }
 
+extern "C" void handle_trigger_signal(int) {
+    brd::capture::triggered_writer::external_trigger();
+}
+
+volatile std::sig_atomic_t stopped = 0;
+
+extern "C" void handle_stop_signal(int) {
+    stopped = 1;
+}
+
+// without SA_RESTART, so that a blocked receive returns
+void install_stop_handler() {
+    struct sigaction action;
+    action.sa_handler = handle_stop_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+    sigaction(SIGINT, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+}
+
 }
 
 int main(int argc, char* argv[]) {
@@ -49,6 +79,19 @@ int main(int argc, char* argv[]) {
         std::string address;
         std::size_t size;
         std::size_t sobuffsize;
+        std::string trigger;
+        brd::capture::trigger_config trigger_config;
+        std::string stats;
+        std::size_t stats_block;
+        std::size_t decimation;
+        std::string recording;
+        uint64_t index_interval;
+        std::string control;
+        double high_watermark;
+        double low_watermark;
+        int cpu;
+        int rt_priority;
+        unsigned busy_poll;
         desc.add_options()
             ("help,h", "produce help message")
             ("address,a", po::value<std::string>(&address), 
@@ -57,7 +100,63 @@ int main(int argc, char* argv[]) {
              "buffer size in bytes, default: 1024")
             ("bsize,b", 
              po::value<std::size_t>(&sobuffsize)->default_value(4*1024*1024), 
-             "socket buffer size in bytes");
+             "socket buffer size in bytes")
+            ("trigger,t", po::value<std::string>(&trigger),
+             "write only windows around trigger events: "
+             "level, rising, falling or external (SIGUSR1)")
+            ("threshold", 
+             po::value<int>(&trigger_config.threshold)->default_value(0),
+             "trigger threshold for 16-bit samples")
+            ("pretrigger",
+             po::value<std::size_t>(&trigger_config.pretrigger)->
+                 default_value(4096),
+             "samples kept before the trigger")
+            ("posttrigger",
+             po::value<std::size_t>(&trigger_config.posttrigger)->
+                 default_value(4096),
+             "samples written from the trigger on")
+            ("stats", po::value<std::string>(&stats),
+             "emit per-block min/max/mean/rms and a decimated preview "
+             "to a file, FIFO or udp://host:port")
+            ("stats-block",
+             po::value<std::size_t>(&stats_block)->default_value(65536),
+             "statistics block size in samples")
+            ("decimation",
+             po::value<std::size_t>(&decimation)->default_value(64),
+             "preview decimation ratio")
+            ("record,r", po::value<std::string>(&recording),
+             "write the stream with receive timestamps and a seek index "
+             "to a recording instead of stdout")
+            ("index-interval",
+             po::value<uint64_t>(&index_interval)->
+                 default_value(1024*1024),
+             "bytes of recording between seek index entries")
+            ("backpressure",
+             "pause the board stream when the receive buffer fills up "
+             "instead of dropping data")
+            ("control", po::value<std::string>(&control),
+             "board control bus address, host[:port], "
+             "default is the board host with port 3001")
+            ("high-watermark",
+             po::value<double>(&high_watermark)->default_value(0.75),
+             "receive buffer fraction that pauses the stream")
+            ("low-watermark",
+             po::value<double>(&low_watermark)->default_value(0.25),
+             "receive buffer fraction that resumes the stream")
+            ("cpu", po::value<int>(&cpu),
+             "pin the receive thread to this cpu")
+            ("rt-priority",
+             po::value<int>(&rt_priority)->default_value(0),
+             "SCHED_FIFO priority of the receive thread, 0 keeps "
+             "normal scheduling")
+            ("lock-memory",
+             "receive into mlocked, huge page backed memory")
+            ("busy-poll",
+             po::value<unsigned>(&busy_poll)->default_value(0),
+             "busy poll the socket for this many microseconds "
+             "(SO_BUSY_POLL), with --cpu spin on receive as well")
+            ("low-latency",
+             "shorthand for --rt-priority 50 --lock-memory --busy-poll 50");
 
         po::positional_options_description p;
         p.add("address", 1);
@@ -103,13 +202,113 @@ int main(int argc, char* argv[]) {
                           << std::endl;
             }
         }
+        if (vm.count("trigger") && vm.count("record"))
+            throw std::runtime_error("--trigger and --record "
+                                     "are mutually exclusive");
+
+        boost::scoped_ptr<brd::capture::triggered_writer> triggered;
+        if (vm.count("trigger")) {
+            trigger_config.mode = brd::capture::parse_trigger_mode(trigger);
+            triggered.reset(new brd::capture::triggered_writer(trigger_config,
+                                                               std::cout));
+            if (trigger_config.mode == brd::capture::TRIGGER_EXTERNAL)
+                std::signal(SIGUSR1, impl::handle_trigger_signal);
+        }
+
+        boost::scoped_ptr<brd::capture::stats_writer> summary;
+        if (vm.count("stats")) {
+            std::signal(SIGPIPE, SIG_IGN);
+            summary.reset(new brd::capture::stats_writer(stats, stats_block,
+                                                         decimation));
+        }
+
+        boost::scoped_ptr<brd::record::recording_writer> recorder;
+        if (vm.count("record"))
+            recorder.reset(new brd::record::recording_writer(recording,
+                                                            index_interval));
+
         impl::initialize_board_connection(socket);
-        std::vector<char> data(size);
-        while (true) {
-            std::size_t sz = socket.receive(boost::asio::buffer(data));
-            std::cout.write(&data[0], sz);
+        brd::capture::stream_receiver receiver(socket.native_handle());
+
+        boost::scoped_ptr<brd::capture::flow_control> flow;
+        if (vm.count("backpressure")) {
+            brd::board::board_ptr board(
+                new brd::board::b101e1ngu(vm.count("control") ? 
+                                          control : host));
+            flow.reset(new brd::capture::flow_control(board, high_watermark,
+                                                      low_watermark));
+        }
+
+        bool low_latency = vm.count("low-latency");
+        if (low_latency) {
+            if (vm["rt-priority"].defaulted())
+                rt_priority = 50;
+            if (vm["busy-poll"].defaulted())
+                busy_poll = 50;
         }
-        
+        if (vm.count("cpu"))
+            brd::capture::pin_thread(cpu);
+        if (rt_priority && !brd::capture::set_realtime(rt_priority))
+            std::cerr << "warning: SCHED_FIFO is not permitted, "
+                         "the receive thread keeps normal scheduling"
+                      << std::endl;
+        if (busy_poll && !receiver.busy_poll(busy_poll))
+            std::cerr << "warning: SO_BUSY_POLL is not permitted, "
+                         "check /proc/sys/net/core/busy_read"
+                      << std::endl;
+        // a spinning thread, realtime at that, must not roam over cpus
+        // other work needs
+        receiver.spin(busy_poll && vm.count("cpu"));
+        bool measure = low_latency || vm.count("cpu") || rt_priority ||
+                       busy_poll || vm.count("lock-memory");
+        receiver.measure_latency(measure);
+        bool lock_memory = low_latency || vm.count("lock-memory");
+        brd::capture::receive_buffer buffer(size, lock_memory);
+        if (lock_memory && !buffer.locked())
+            std::cerr << "warning: mlock is not permitted, the receive "
+                         "buffer stays unlocked, check ulimit -l"
+                      << std::endl;
+
+        impl::install_stop_handler();
+        char* data = buffer.data();
+        for (uint32_t n = 0; std::cout && !impl::stopped; ++n) {
+            // while paused the queue only drains, so it is checked
+            // before every receive lest the last one blocks for good
+            if (flow && (flow->paused() || n%16 == 0))
+                flow->update(receiver.occupancy());
+            timespec stamp;
+            std::size_t sz = receiver.receive(data, buffer.size(), stamp);
+            if (!sz)
+                continue;
+            if (summary)
+                summary->process(data, sz, stamp);
+            if (triggered) {
+                triggered->process(data, sz, stamp);
+            } else if (recorder) {
+                recorder->write(data, sz, stamp);
+            } else {
+                std::cout.write(data, sz);
+            }
+        }
+        if (!std::cout)
+            throw std::runtime_error("output stream error");
+
+        if (flow)
+            std::cerr << "stream pauses: " << flow->pauses()
+                      << ", resumes: " << flow->resumes() << std::endl;
+        if (receiver.dropped())
+            std::cerr << "datagrams dropped by the kernel: "
+                      << receiver.dropped() << std::endl;
+        const brd::capture::latency_stats& latency = receiver.latency();
+        if (measure && latency.count)
+            std::cerr << "receive latency mean: "
+                      << latency.total/latency.count/1000
+                      << " us, max: " << latency.max/1000 << " us"
+                      << std::endl;
+        if (summary && summary->dropped())
+            std::cerr << "statistics records dropped: "
+                      << summary->dropped() << std::endl;
+
     } catch(std::exception& e) {
         std::cerr << e.what() << std::endl;
         return EXIT_FAILURE;
@@ -0,0 +1,77 @@
+#ifndef BRD_BUS_PACKET_HPP
+#define BRD_BUS_PACKET_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace brd { namespace bus {
+
+// Layout of the READMEM/WRITEMEM register protocol. A request is an
+// 8-word header optionally followed by the words to write, an answer
+// echoes the header and carries the words read. Words travel little
+// endian whatever the host byte order is.
+
+enum command {
+    READMEM = 0x300,
+    WRITEMEM = 0x400
+};
+
+static const uint32_t packet_signature = 0x12344321;
+static const std::size_t header_words = 8;
+static const std::size_t max_burst = 256;
+static const std::size_t max_packet_words = header_words + max_burst;
+
+constexpr uint32_t swap_bytes(uint32_t v) {
+    return (v >> 24) | ((v >> 8) & 0xff00) |
+           ((v << 8) & 0xff0000) | (v << 24);
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr uint32_t to_wire(uint32_t v) { return swap_bytes(v); }
+#else
+constexpr uint32_t to_wire(uint32_t v) { return v; }
+#endif
+
+constexpr uint32_t from_wire(uint32_t v) { return to_wire(v); }
+
+struct packet_header {
+    uint32_t word[header_words];
+};
+
+constexpr packet_header make_header(uint32_t cmd, uint32_t type,
+                                    uint32_t address, uint32_t words) {
+    return packet_header{{ to_wire(packet_signature), to_wire(cmd),
+                           to_wire(type), to_wire(address),
+                           to_wire(words*sizeof(uint32_t)), 0, 0, 0 }};
+}
+
+// A request or answer on the stack, large enough for any burst.
+struct packet {
+    packet_header header;
+    uint32_t payload[max_burst];
+
+    std::size_t bytes(std::size_t words) const {
+        return sizeof(header) + words*sizeof(uint32_t);
+    }
+
+    uint32_t command() const { return from_wire(header.word[1]); }
+    uint32_t address() const { return from_wire(header.word[3]); }
+
+    void encode(const packet_header& h) { header = h; }
+
+    void encode(const packet_header& h, const uint32_t* data,
+                std::size_t count) {
+        header = h;
+        for (std::size_t i = 0; i < count; ++i)
+            payload[i] = to_wire(data[i]);
+    }
+
+    void decode(uint32_t* data, std::size_t count) const {
+        for (std::size_t i = 0; i < count; ++i)
+            data[i] = from_wire(payload[i]);
+    }
+};
+
+}} //namespace brd::bus
+
+#endif //BRD_BUS_PACKET_HPP
@@ -0,0 +1,38 @@
+#include "flow_control.hpp"
+
+namespace brd { namespace capture {
+
+flow_control::flow_control(board::board_ptr board, double high, double low)
+    : board_(board)
+    , high_(high)
+    , low_(low)
+    , paused_(false)
+    , pauses_(0)
+    , resumes_(0) {
+    // an empty buffer must resume the stream, nothing else arrives
+    // while it is paused
+    if (!(0 < low_ && low_ < high_ && high_ <= 1))
+        throw flow_control_error("watermarks must be 0 < low < high <= 1");
+    board_->enable_stream(true);
+}
+
+flow_control::~flow_control() {
+    try {
+        if (paused_)
+            board_->enable_stream(true);
+    } catch(...) {}
+}
+
+void flow_control::update(double occupancy) {
+    if (!paused_ && occupancy >= high_) {
+        board_->enable_stream(false);
+        paused_ = true;
+        ++pauses_;
+    } else if (paused_ && occupancy <= low_) {
+        board_->enable_stream(true);
+        paused_ = false;
+        ++resumes_;
+    }
+}
+
+}} //namespace brd::capture
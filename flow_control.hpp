@@ -0,0 +1,44 @@
+#ifndef BRD_FLOW_CONTROL_HPP
+#define BRD_FLOW_CONTROL_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+#include "iboard.hpp"
+
+namespace brd { namespace capture {
+
+struct flow_control_error : std::runtime_error {
+    flow_control_error(const std::string& what_arg) throw()
+        : std::runtime_error("flow control: " + what_arg) {}
+};
+
+// Pauses the board stream when the receive buffer occupancy reaches
+// the high watermark and resumes it below the low one, so that a slow
+// consumer throttles the board instead of losing datagrams. While
+// paused `update` must be called before every receive, the low
+// watermark is positive so that the drained buffer always resumes.
+struct flow_control : boost::noncopyable {
+    flow_control(board::board_ptr board, double high, double low);
+    ~flow_control();
+
+    void update(double occupancy);
+
+    bool paused() const { return paused_; }
+    uint32_t pauses() const { return pauses_; }
+    uint32_t resumes() const { return resumes_; }
+private:
+    board::board_ptr board_;
+    double high_;
+    double low_;
+    bool paused_;
+    uint32_t pauses_;
+    uint32_t resumes_;
+};
+
+}} //namespace brd::capture
+
+#endif //BRD_FLOW_CONTROL_HPP
@@ -10,6 +10,9 @@ struct iboard {
     virtual void reset(bool flash_boot = false) = 0;
     virtual void start() = 0;
     virtual void load(const std::string& path, int argc, char* argv[]) = 0;
+    virtual void load_staged(const std::string& stub, const std::string& path,
+                             int argc, char* argv[]) = 0;
+    virtual void enable_stream(bool enable) = 0;
     virtual ~iboard() {};
 };
 
@@ -26,6 +26,18 @@ struct ibus {
     virtual value_type read(const address&) = 0;
     virtual void write(const address&, value_type) = 0;
     virtual ~ibus() {};
+
+    // contiguous transfers, buses that support bursts override these
+    virtual void read_block(const address& addr, value_type* data,
+                            std::size_t count) {
+        read(addr, data, data + count);
+    }
+
+    virtual void write_block(const address& addr, const value_type* data,
+                             std::size_t count) {
+        write(addr, data, data + count);
+    }
+
     template <typename Iterator>
     void write(address addr, Iterator first, Iterator last) {
         while (first != last) {
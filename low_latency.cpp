@@ -0,0 +1,97 @@
+#include <cerrno>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "low_latency.hpp"
+
+namespace brd { namespace capture {
+
+void pin_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err)
+        throw low_latency_error("can't pin to cpu " + std::to_string(cpu) +
+                                ": " + std::strerror(err));
+}
+
+bool set_realtime(int priority) {
+    sched_param param;
+    param.sched_priority = priority;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err == EPERM)
+        return false;
+    if (err)
+        throw low_latency_error(std::string("SCHED_FIFO: ") +
+                                std::strerror(err));
+    return true;
+}
+
+namespace {
+
+// true if the lock failed for lack of privilege or RLIMIT_MEMLOCK
+bool lock_denied(int err) {
+    return err == EPERM || err == ENOMEM || err == EAGAIN;
+}
+
+}
+
+receive_buffer::receive_buffer(std::size_t size, bool lock)
+    : data_(0)
+    , size_(size)
+    , mapped_(size)
+    , huge_(false)
+    , locked_(false) {
+    const std::size_t huge_page = 2*1024*1024;
+    if (lock) {
+        mapped_ = (size + huge_page - 1)/huge_page*huge_page;
+        void* p = ::mmap(0, mapped_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            data_ = static_cast<char*>(p);
+            huge_ = true;
+            locked_ = ::mlock(data_, mapped_) == 0;
+            if (!locked_) {
+                // a whole huge page may exceed RLIMIT_MEMLOCK where the
+                // buffer alone does not, retry with normal pages
+                int err = errno;
+                ::munmap(data_, mapped_);
+                data_ = 0;
+                huge_ = false;
+                if (!lock_denied(err))
+                    throw low_latency_error(std::string("can't lock buffer: ")
+                                            + std::strerror(err));
+            }
+        }
+        if (!huge_)
+            mapped_ = size;
+    }
+    if (!data_) {
+        void* p = ::mmap(0, mapped_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw low_latency_error(std::string("can't map buffer: ") +
+                                    std::strerror(errno));
+        data_ = static_cast<char*>(p);
+        if (lock) {
+            ::madvise(data_, mapped_, MADV_HUGEPAGE);
+            locked_ = ::mlock(data_, mapped_) == 0;
+            if (!locked_ && !lock_denied(errno)) {
+                int err = errno;
+                ::munmap(data_, mapped_);
+                throw low_latency_error(std::string("can't lock buffer: ") +
+                                        std::strerror(err));
+            }
+        }
+    }
+}
+
+receive_buffer::~receive_buffer() {
+    ::munmap(data_, mapped_);
+}
+
+}} //namespace brd::capture
@@ -0,0 +1,46 @@
+#ifndef BRD_LOW_LATENCY_HPP
+#define BRD_LOW_LATENCY_HPP
+
+#include <stdexcept>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+namespace brd { namespace capture {
+
+struct low_latency_error : std::runtime_error {
+    low_latency_error(const std::string& what_arg) throw()
+        : std::runtime_error("low latency: " + what_arg) {}
+};
+
+// pins the calling thread to `cpu`
+void pin_thread(int cpu);
+
+// Switches the calling thread to SCHED_FIFO with `priority`, returns
+// false if the process is not permitted to.
+bool set_realtime(int priority);
+
+// Receive buffer of anonymous memory. A locked buffer is backed by
+// huge pages when the system has them reserved, falls back to
+// transparent huge pages otherwise, and is mlocked when permitted:
+// if RLIMIT_MEMLOCK can't take a huge page it is retried with normal
+// pages, and if it can't take those either the buffer stays unlocked.
+struct receive_buffer : boost::noncopyable {
+    receive_buffer(std::size_t size, bool lock);
+    ~receive_buffer();
+
+    char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool huge() const { return huge_; }
+    bool locked() const { return locked_; }
+private:
+    char* data_;
+    std::size_t size_;
+    std::size_t mapped_;
+    bool huge_;
+    bool locked_;
+};
+
+}} //namespace brd::capture
+
+#endif //BRD_LOW_LATENCY_HPP
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <fstream>
+
+#include "memory_snapshot.hpp"
+
+namespace brd { namespace mem {
+
+typedef bus::ibus::value_type value_type;
+
+namespace {
+
+struct snapshot_file {
+    explicit snapshot_file(const std::string& path)
+        : file_(path.c_str(), std::ios::binary) {
+        if (!file_)
+            throw snapshot_error("can't open " + path);
+        file_.read(reinterpret_cast<char*>(&header_), sizeof(header_));
+        if (!file_ || header_.magic != snapshot_header::signature ||
+            header_.version != snapshot_header::current_version)
+            throw snapshot_error("bad header in " + path);
+        file_.seekg(0, std::ios::end);
+        if (static_cast<uint64_t>(file_.tellg()) <
+            sizeof(header_) + uint64_t(header_.count)*sizeof(value_type))
+            throw snapshot_error("incomplete snapshot " + path);
+    }
+
+    void read(uint32_t offset, value_type* data, uint32_t count) {
+        file_.seekg(sizeof(header_) + uint64_t(offset)*sizeof(value_type));
+        file_.read(reinterpret_cast<char*>(data), count*sizeof(value_type));
+        if (!file_)
+            throw snapshot_error("read error");
+    }
+
+    bus::address start() const {
+        return bus::address(header_.type, header_.start);
+    }
+
+    uint32_t count() const { return header_.count; }
+private:
+    std::ifstream file_;
+    snapshot_header header_;
+};
+
+void check_chunk(uint32_t chunk) {
+    if (chunk == 0)
+        throw snapshot_error("chunk size must be positive");
+}
+
+} //namespace
+
+void dump(bus::bus_ptr bus, const bus::address& start, uint32_t count,
+          const std::string& path, uint32_t chunk, bool resume) {
+    check_chunk(chunk);
+    snapshot_header header = { snapshot_header::signature,
+                               snapshot_header::current_version,
+                               start.type(), start.value(), count, 0 };
+    uint32_t done = 0;
+    std::fstream file;
+    if (resume) {
+        file.open(path.c_str(), std::ios::in | std::ios::out |
+                                std::ios::binary);
+        if (file.is_open()) {
+            snapshot_header existing;
+            file.read(reinterpret_cast<char*>(&existing), sizeof(existing));
+            if (!file || existing.magic != header.magic ||
+                existing.version != header.version ||
+                existing.type != header.type ||
+                existing.start != header.start ||
+                existing.count != header.count)
+                throw snapshot_error(path + " is a snapshot of "
+                                     "another region");
+            file.seekg(0, std::ios::end);
+            uint64_t words = (static_cast<uint64_t>(file.tellg()) -
+                              sizeof(header))/sizeof(value_type);
+            done = std::min<uint64_t>(words - words%chunk, count);
+        }
+    }
+    if (!file.is_open()) {
+        file.open(path.c_str(), std::ios::out | std::ios::trunc |
+                                std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    if (!file)
+        throw snapshot_error("can't write " + path);
+
+    file.seekp(sizeof(header) + uint64_t(done)*sizeof(value_type));
+    std::vector<value_type> data(chunk);
+    while (done < count) {
+        uint32_t n = std::min(chunk, count - done);
+        bus->read_block(start + done, &data[0], n);
+        file.write(reinterpret_cast<const char*>(&data[0]),
+                   n*sizeof(value_type));
+        file.flush();
+        if (!file)
+            throw snapshot_error("write error in " + path);
+        done += n;
+    }
+}
+
+std::vector<block> diff(bus::bus_ptr bus, const std::string& path,
+                        uint32_t chunk) {
+    check_chunk(chunk);
+    snapshot_file snapshot(path);
+    std::vector<value_type> saved(chunk);
+    std::vector<value_type> live(chunk);
+    std::vector<block> blocks;
+    for (uint32_t offset = 0; offset < snapshot.count(); offset += chunk) {
+        uint32_t n = std::min(chunk, snapshot.count() - offset);
+        snapshot.read(offset, &saved[0], n);
+        bus->read_block(snapshot.start() + offset, &live[0], n);
+        if (std::equal(saved.begin(), saved.begin() + n, live.begin()))
+            continue;
+        if (!blocks.empty() &&
+            blocks.back().offset + blocks.back().count == offset)
+            blocks.back().count += n;
+        else
+            blocks.push_back(block(offset, n));
+    }
+    return blocks;
+}
+
+uint32_t restore(bus::bus_ptr bus, const std::string& path, uint32_t chunk,
+                 bool changed_only) {
+    check_chunk(chunk);
+    snapshot_file snapshot(path);
+    std::vector<value_type> saved(chunk);
+    std::vector<value_type> live(chunk);
+    uint32_t written = 0;
+    for (uint32_t offset = 0; offset < snapshot.count(); offset += chunk) {
+        uint32_t n = std::min(chunk, snapshot.count() - offset);
+        snapshot.read(offset, &saved[0], n);
+        if (changed_only) {
+            bus->read_block(snapshot.start() + offset, &live[0], n);
+            if (std::equal(saved.begin(), saved.begin() + n, live.begin()))
+                continue;
+        }
+        bus->write_block(snapshot.start() + offset, &saved[0], n);
+        written += n;
+    }
+    return written;
+}
+
+}} //namespace brd::mem
@@ -0,0 +1,57 @@
+#ifndef BRD_MEMORY_SNAPSHOT_HPP
+#define BRD_MEMORY_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ibus.hpp"
+
+namespace brd { namespace mem {
+
+struct snapshot_error : std::runtime_error {
+    snapshot_error(const std::string& what_arg) throw()
+        : std::runtime_error("snapshot: " + what_arg) {}
+};
+
+// A snapshot file is this header followed by `count` words read from
+// `count` consecutive addresses of bus `type` starting at `start`.
+struct snapshot_header {
+    static const uint32_t signature = 0x4D445242; // "BRDM"
+    static const uint32_t current_version = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t type;
+    uint32_t start;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+// a range of words, offsets are relative to the snapshot start
+struct block {
+    block(uint32_t offset, uint32_t count) : offset(offset), count(count) {}
+
+    uint32_t offset;
+    uint32_t count;
+};
+
+// Dumps `count` words from `start` to `path` chunk by chunk, every
+// chunk is on disk before the next one is read. With `resume` an
+// interrupted dump of the same region continues from its last chunk.
+void dump(bus::bus_ptr bus, const bus::address& start, uint32_t count,
+          const std::string& path, uint32_t chunk, bool resume = false);
+
+// chunks of the region of the snapshot that differ from memory
+std::vector<block> diff(bus::bus_ptr bus, const std::string& path,
+                        uint32_t chunk);
+
+// Writes the snapshot back to memory, with `changed_only` only the
+// chunks that differ are written. Returns the number of words written.
+uint32_t restore(bus::bus_ptr bus, const std::string& path, uint32_t chunk,
+                 bool changed_only = true);
+
+}} //namespace brd::mem
+
+#endif //BRD_MEMORY_SNAPSHOT_HPP
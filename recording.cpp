@@ -0,0 +1,191 @@
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "recording.hpp"
+
+namespace brd { namespace record {
+
+std::string index_path(const std::string& path) {
+    return path + ".idx";
+}
+
+recording_writer::recording_writer(const std::string& path,
+                                   uint64_t interval)
+    : data_(path.c_str(), std::ios::binary | std::ios::trunc)
+    , index_(index_path(path).c_str(), std::ios::binary | std::ios::trunc)
+    , interval_(interval)
+    , offset_(sizeof(file_header))
+    , unindexed_(interval) {
+    if (!data_ || !index_)
+        throw recording_error("can't create " + path);
+
+    file_header header = { file_header::data_signature,
+                           file_header::current_version };
+    data_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    header.magic = file_header::index_signature;
+    index_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void recording_writer::write(const char* data, std::size_t size,
+                             const timespec& stamp) {
+    if (unindexed_ >= interval_) {
+        index_entry entry;
+        entry.sec = stamp.tv_sec;
+        entry.nsec = stamp.tv_nsec;
+        entry.reserved = 0;
+        entry.offset = offset_;
+        index_.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        unindexed_ = 0;
+    }
+
+    record_header header;
+    header.sec = stamp.tv_sec;
+    header.nsec = stamp.tv_nsec;
+    header.size = size;
+    data_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    data_.write(data, size);
+    if (!data_ || !index_)
+        throw recording_error("write error");
+
+    offset_ += sizeof(header) + size;
+    unindexed_ += sizeof(header) + size;
+}
+
+struct recording_reader::mapping {
+    explicit mapping(const std::string& path)
+        : base_(0)
+        , size_(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw recording_error(path + ": " + std::strerror(errno));
+        struct stat st;
+        if (::fstat(fd, &st) == 0)
+            size_ = st.st_size;
+        if (size_ > 0) {
+            void* p = ::mmap(0, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED)
+                base_ = static_cast<const char*>(p);
+        }
+        ::close(fd);
+        if (!base_)
+            throw recording_error("can't map " + path);
+    }
+
+    ~mapping() {
+        ::munmap(const_cast<char*>(base_), size_);
+    }
+
+    void check(uint32_t signature, const std::string& path) const {
+        file_header header;
+        if (size_ < sizeof(header))
+            throw recording_error("truncated " + path);
+        std::memcpy(&header, base_, sizeof(header));
+        if (header.magic != signature ||
+            header.version != file_header::current_version)
+            throw recording_error("bad header in " + path);
+    }
+
+    const char* base() const { return base_; }
+    uint64_t size() const { return size_; }
+private:
+    const char* base_;
+    uint64_t size_;
+};
+
+recording_reader::recording_reader(const std::string& path)
+    : data_(new mapping(path))
+    , index_(new mapping(index_path(path)))
+    , end_(data_->size()) {
+    data_->check(file_header::data_signature, path);
+    index_->check(file_header::index_signature, index_path(path));
+}
+
+namespace {
+
+timespec stamp_of(const index_entry& entry) {
+    timespec stamp;
+    stamp.tv_sec = entry.sec;
+    stamp.tv_nsec = entry.nsec;
+    return stamp;
+}
+
+struct entry_at {
+    explicit entry_at(const char* base) : base_(base) {}
+    index_entry operator()(std::size_t i) const {
+        index_entry entry;
+        std::memcpy(&entry, base_ + i*sizeof(entry), sizeof(entry));
+        return entry;
+    }
+private:
+    const char* base_;
+};
+
+} //namespace
+
+uint64_t recording_reader::seek(const timespec& stamp) const {
+    entry_at entry(index_->base() + sizeof(file_header));
+    std::size_t first = 0;
+    std::size_t count = (index_->size() - sizeof(file_header))/
+                        sizeof(index_entry);
+    // first entry not earlier than stamp
+    while (count) {
+        std::size_t step = count/2;
+        if (earlier(stamp_of(entry(first + step)), stamp)) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+
+    uint64_t offset = first ? entry(first - 1).offset : begin();
+    record rec;
+    while (offset < end()) {
+        uint64_t next = read(offset, rec);
+        if (!rec.data)
+            return end();
+        if (!earlier(rec.stamp, stamp))
+            break;
+        offset = next;
+    }
+    return offset;
+}
+
+uint64_t recording_reader::last() const {
+    entry_at entry(index_->base() + sizeof(file_header));
+    std::size_t count = (index_->size() - sizeof(file_header))/
+                        sizeof(index_entry);
+    uint64_t offset = count ? entry(count - 1).offset : begin();
+    record rec;
+    for (uint64_t next = offset; next < end(); ) {
+        uint64_t current = next;
+        next = read(current, rec);
+        if (!rec.data)
+            break;
+        offset = current;
+    }
+    return offset;
+}
+
+uint64_t recording_reader::read(uint64_t offset, record& rec) const {
+    record_header header;
+    rec.data = 0;
+    if (offset + sizeof(header) > end())
+        return end();
+    std::memcpy(&header, data_->base() + offset, sizeof(header));
+    uint64_t next = offset + sizeof(header) + header.size;
+    if (next > end())
+        return end();
+    rec.stamp.tv_sec = header.sec;
+    rec.stamp.tv_nsec = header.nsec;
+    rec.data = data_->base() + offset + sizeof(header);
+    rec.size = header.size;
+    return next;
+}
+
+}} //namespace brd::record
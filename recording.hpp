@@ -0,0 +1,99 @@
+#ifndef BRD_RECORDING_HPP
+#define BRD_RECORDING_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace brd { namespace record {
+
+struct recording_error : std::runtime_error {
+    recording_error(const std::string& what_arg) throw()
+        : std::runtime_error("recording: " + what_arg) {}
+};
+
+// A recording is a data file and a sparse seek index next to it
+// (path + ".idx"). Both start with a file_header. The data file holds
+// records, each one a record_header followed by `size` bytes of one
+// received datagram. The index holds an index_entry pointing at the
+// first record after every `interval` bytes of data.
+struct file_header {
+    static const uint32_t data_signature = 0x52445242;  // "BRDR"
+    static const uint32_t index_signature = 0x49445242; // "BRDI"
+    static const uint32_t current_version = 1;
+
+    uint32_t magic;
+    uint32_t version;
+};
+
+struct record_header {
+    uint64_t sec;
+    uint32_t nsec;
+    uint32_t size;
+};
+
+struct index_entry {
+    uint64_t sec;
+    uint32_t nsec;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+inline bool earlier(const timespec& lhs, const timespec& rhs) {
+    return lhs.tv_sec < rhs.tv_sec ||
+           (lhs.tv_sec == rhs.tv_sec && lhs.tv_nsec < rhs.tv_nsec);
+}
+
+std::string index_path(const std::string& path);
+
+struct recording_writer : boost::noncopyable {
+    recording_writer(const std::string& path,
+                     uint64_t interval = 1024*1024);
+
+    void write(const char* data, std::size_t size, const timespec& stamp);
+private:
+    std::ofstream data_;
+    std::ofstream index_;
+    uint64_t interval_;
+    uint64_t offset_;
+    uint64_t unindexed_;
+};
+
+struct record {
+    timespec stamp;
+    const char* data;
+    std::size_t size;
+};
+
+// Maps a recording into memory and seeks it by binary search over the
+// index. Timestamps are expected to be non-decreasing.
+struct recording_reader : boost::noncopyable {
+    explicit recording_reader(const std::string& path);
+
+    // offset of the first record not earlier than `stamp`
+    uint64_t seek(const timespec& stamp) const;
+
+    // reads the record at `offset`, returns the offset of the next one,
+    // rec.data is null if the record is truncated
+    uint64_t read(uint64_t offset, record& rec) const;
+
+    // offset of the last complete record
+    uint64_t last() const;
+
+    uint64_t begin() const { return sizeof(file_header); }
+    uint64_t end() const { return end_; }
+    struct mapping;
+private:
+    boost::shared_ptr<mapping> data_;
+    boost::shared_ptr<mapping> index_;
+    uint64_t end_;
+};
+
+}} //namespace brd::record
+
+#endif //BRD_RECORDING_HPP
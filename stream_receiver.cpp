@@ -0,0 +1,88 @@
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/sock_diag.h>
+
+#include "stream_receiver.hpp"
+
+namespace brd { namespace capture {
+
+stream_receiver::stream_receiver(int fd)
+    : fd_(fd)
+    , spin_(false)
+    , measure_(false)
+    , dropped_(0) {
+    int on = 1;
+    if (::setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0)
+        throw receiver_error(std::string("SO_TIMESTAMPNS: ") +
+                             std::strerror(errno));
+    if (::setsockopt(fd_, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0)
+        throw receiver_error(std::string("SO_RXQ_OVFL: ") +
+                             std::strerror(errno));
+}
+
+bool stream_receiver::busy_poll(unsigned usec) {
+    int value = usec;
+    return ::setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL,
+                        &value, sizeof(value)) == 0;
+}
+
+std::size_t stream_receiver::receive(char* data, std::size_t size,
+                                     timespec& stamp) {
+    iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = size;
+
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control_;
+    msg.msg_controllen = sizeof(control_);
+
+    ssize_t n = ::recvmsg(fd_, &msg, spin_ ? MSG_DONTWAIT : 0);
+    if (n < 0 && (errno == EINTR || (spin_ && errno == EAGAIN)))
+        return 0;
+    if (n < 0)
+        throw receiver_error(std::strerror(errno));
+
+    bool stamped = false;
+    for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            std::memcpy(&stamp, CMSG_DATA(c), sizeof(stamp));
+            stamped = true;
+        } else if (c->cmsg_level == SOL_SOCKET &&
+                   c->cmsg_type == SO_RXQ_OVFL) {
+            std::memcpy(&dropped_, CMSG_DATA(c), sizeof(dropped_));
+        }
+    }
+    if (!stamped) {
+        clock_gettime(CLOCK_REALTIME, &stamp);
+    } else if (measure_) {
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        int64_t delay = (now.tv_sec - stamp.tv_sec)*1000000000LL +
+                        (now.tv_nsec - stamp.tv_nsec);
+        if (delay > 0) {
+            ++latency_.count;
+            latency_.total += delay;
+            if (static_cast<uint64_t>(delay) > latency_.max)
+                latency_.max = delay;
+        }
+    }
+    return n;
+}
+
+double stream_receiver::occupancy() const {
+    uint32_t meminfo[SK_MEMINFO_VARS];
+    socklen_t len = sizeof(meminfo);
+    if (::getsockopt(fd_, SOL_SOCKET, SO_MEMINFO, meminfo, &len) < 0)
+        throw receiver_error(std::string("SO_MEMINFO: ") +
+                             std::strerror(errno));
+    return static_cast<double>(meminfo[SK_MEMINFO_RMEM_ALLOC])/
+           meminfo[SK_MEMINFO_RCVBUF];
+}
+
+}} //namespace brd::capture
@@ -0,0 +1,65 @@
+#ifndef BRD_STREAM_RECEIVER_HPP
+#define BRD_STREAM_RECEIVER_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+namespace brd { namespace capture {
+
+struct receiver_error : std::runtime_error {
+    receiver_error(const std::string& what_arg) throw()
+        : std::runtime_error("receiver: " + what_arg) {}
+};
+
+// delay between the kernel receive timestamp and the datagram
+// reaching the receiving thread
+struct latency_stats {
+    latency_stats() : count(0), total(0), max(0) {}
+
+    uint64_t count;
+    uint64_t total; // ns
+    uint64_t max;   // ns
+};
+
+// Receives datagrams from a connected socket together with the kernel
+// receive timestamp (SO_TIMESTAMPNS) and the count of datagrams the
+// kernel dropped for lack of buffer space (SO_RXQ_OVFL).
+struct stream_receiver : boost::noncopyable {
+    explicit stream_receiver(int fd);
+
+    // returns 0 if interrupted by a signal or, when spinning, if no
+    // datagram is pending
+    std::size_t receive(char* data, std::size_t size, timespec& stamp);
+
+    // fraction of the socket receive buffer in use
+    double occupancy() const;
+
+    // Polls the device queue for `usec` microseconds in the kernel on
+    // a blocking receive (SO_BUSY_POLL). Returns false if it is not
+    // permitted.
+    bool busy_poll(unsigned usec);
+
+    // spins on non-blocking receive instead of sleeping, only meant
+    // for a thread pinned to a cpu of its own
+    void spin(bool enable) { spin_ = enable; }
+
+    void measure_latency(bool enable) { measure_ = enable; }
+    const latency_stats& latency() const { return latency_; }
+
+    uint32_t dropped() const { return dropped_; }
+private:
+    int fd_;
+    bool spin_;
+    bool measure_;
+    latency_stats latency_;
+    uint32_t dropped_;
+    char control_[128];
+};
+
+}} //namespace brd::capture
+
+#endif //BRD_STREAM_RECEIVER_HPP
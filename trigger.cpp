@@ -0,0 +1,160 @@
+#include <csignal>
+#include <cstring>
+#include <algorithm>
+
+#include "trigger.hpp"
+
+namespace brd { namespace capture {
+
+namespace {
+volatile std::sig_atomic_t external_pending = 0;
+}
+
+trigger_mode parse_trigger_mode(const std::string& name) {
+    if (name == "level")
+        return TRIGGER_LEVEL;
+    if (name == "rising")
+        return TRIGGER_RISING;
+    if (name == "falling")
+        return TRIGGER_FALLING;
+    if (name == "external")
+        return TRIGGER_EXTERNAL;
+    throw trigger_error("unknown mode " + name);
+}
+
+triggered_writer::triggered_writer(const trigger_config& config,
+                                   std::ostream& out)
+    : config_(config)
+    , out_(out)
+    , history_(config.pretrigger)
+    , head_(0)
+    , filled_(0)
+    , remaining_(0)
+    , position_(0)
+    , previous_(0)
+    , primed_(false)
+    , sequence_(0)
+    , carried_(0) {
+    if (config_.posttrigger == 0)
+        throw trigger_error("post-trigger length must be positive");
+}
+
+void triggered_writer::external_trigger() {
+    external_pending = 1;
+}
+
+void triggered_writer::process(const char* data, std::size_t size,
+                               const timespec& stamp) {
+    sample_type one;
+    if (carried_) {
+        std::size_t n = std::min(sizeof(one) - carried_, size);
+        std::memcpy(carry_ + carried_, data, n);
+        carried_ += n;
+        data += n;
+        size -= n;
+        if (carried_ < sizeof(one))
+            return;
+        std::memcpy(&one, carry_, sizeof(one));
+        carried_ = 0;
+        process(reinterpret_cast<const char*>(&one), sizeof(one), stamp);
+    }
+
+    std::size_t count = size/sizeof(sample_type);
+    const char* p = data;
+    std::size_t i = 0;
+    while (i < count) {
+        if (remaining_) {
+            std::size_t run = std::min(remaining_, count - i);
+            write(p, run);
+            p += run*sizeof(one);
+            std::memcpy(&one, p - sizeof(one), sizeof(one));
+            previous_ = one;
+            primed_ = true;
+            remaining_ -= run;
+            position_ += run;
+            i += run;
+            if (!remaining_) {
+                // the next window starts its history afresh
+                head_ = 0;
+                filled_ = 0;
+            }
+            continue;
+        }
+
+        std::memcpy(&one, p, sizeof(one));
+        if (fired(one)) {
+            begin_window(stamp);
+            remaining_ = config_.posttrigger;
+            continue;
+        }
+        push_history(one);
+        previous_ = one;
+        primed_ = true;
+        p += sizeof(one);
+        ++position_;
+        ++i;
+    }
+
+    carried_ = size - count*sizeof(sample_type);
+    std::memcpy(carry_, data + count*sizeof(sample_type), carried_);
+}
+
+bool triggered_writer::fired(sample_type sample) {
+    switch (config_.mode) {
+    case TRIGGER_LEVEL:
+        return sample >= config_.threshold;
+    case TRIGGER_RISING:
+        return primed_ && previous_ < config_.threshold &&
+               sample >= config_.threshold;
+    case TRIGGER_FALLING:
+        return primed_ && previous_ > config_.threshold &&
+               sample <= config_.threshold;
+    case TRIGGER_EXTERNAL:
+        if (external_pending) {
+            external_pending = 0;
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+void triggered_writer::begin_window(const timespec& stamp) {
+    window_header header;
+    header.magic = window_header::signature;
+    header.sequence = sequence_++;
+    header.sec = stamp.tv_sec;
+    header.nsec = stamp.tv_nsec;
+    header.pretrigger = filled_;
+    header.samples = filled_ + config_.posttrigger;
+    header.reserved = 0;
+    header.index = position_;
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (filled_ < history_.size()) {
+        write(history(0), filled_);
+    } else if (filled_) {
+        write(history(head_), history_.size() - head_);
+        write(history(0), head_);
+    }
+}
+
+void triggered_writer::push_history(sample_type sample) {
+    if (history_.empty())
+        return;
+    history_[head_] = sample;
+    if (++head_ == history_.size())
+        head_ = 0;
+    if (filled_ < history_.size())
+        ++filled_;
+}
+
+const char* triggered_writer::history(std::size_t index) const {
+    return reinterpret_cast<const char*>(&history_[index]);
+}
+
+void triggered_writer::write(const char* first, std::size_t count) {
+    out_.write(first, count*sizeof(sample_type));
+}
+
+}} //namespace brd::capture
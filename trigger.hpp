@@ -0,0 +1,97 @@
+#ifndef BRD_TRIGGER_HPP
+#define BRD_TRIGGER_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace brd { namespace capture {
+
+struct trigger_error : std::runtime_error {
+    trigger_error(const std::string& what_arg) throw()
+        : std::runtime_error("trigger: " + what_arg) {}
+};
+
+enum trigger_mode {
+    TRIGGER_LEVEL,
+    TRIGGER_RISING,
+    TRIGGER_FALLING,
+    TRIGGER_EXTERNAL
+};
+
+trigger_mode parse_trigger_mode(const std::string& name);
+
+struct trigger_config {
+    trigger_config()
+        : mode(TRIGGER_LEVEL)
+        , threshold(0)
+        , pretrigger(4096)
+        , posttrigger(4096) {}
+
+    trigger_mode mode;
+    int threshold;
+    std::size_t pretrigger;  // samples kept before the trigger sample
+    std::size_t posttrigger; // samples written from the trigger sample on
+};
+
+// Every captured window is written as this header followed by
+// `samples` 16-bit samples, the first `pretrigger` of them precede
+// the trigger sample. `index` is the position of the trigger sample in
+// the whole stream, `sec`/`nsec` the receive time of its datagram. The
+// pre-trigger part never reaches back into the previous window.
+struct window_header {
+    static const uint32_t signature = 0x47495254; // "TRIG"
+
+    uint32_t magic;
+    uint32_t sequence;
+    uint64_t sec;
+    uint32_t nsec;
+    uint32_t pretrigger;
+    uint32_t samples;
+    uint32_t reserved;
+    uint64_t index;
+};
+
+// Keeps a pre-trigger history of the stream in a ring and writes only
+// the windows around trigger events. Samples are signed 16-bit.
+struct triggered_writer : boost::noncopyable {
+    typedef int16_t sample_type;
+
+    triggered_writer(const trigger_config& config, std::ostream& out);
+
+    // `stamp` is the receive time of the block
+    void process(const char* data, std::size_t size, const timespec& stamp);
+
+    // async-signal-safe, fires on the first sample of the next block
+    static void external_trigger();
+
+    uint32_t windows() const { return sequence_; }
+private:
+    bool fired(sample_type sample);
+    void begin_window(const timespec& stamp);
+    void push_history(sample_type sample);
+    const char* history(std::size_t index) const;
+    void write(const char* first, std::size_t count);
+private:
+    trigger_config config_;
+    std::ostream& out_;
+    std::vector<sample_type> history_;
+    std::size_t head_;
+    std::size_t filled_;
+    std::size_t remaining_;
+    uint64_t position_;
+    sample_type previous_;
+    bool primed_;
+    uint32_t sequence_;
+    char carry_[sizeof(sample_type)];
+    std::size_t carried_;
+};
+
+}} //namespace brd::capture
+
+#endif //BRD_TRIGGER_HPP
@@ -1,71 +1,190 @@
+#include <cerrno>
 #include <iostream>
+#include <algorithm>
+
+#include <poll.h>
+#include <sys/socket.h>
+
 #include <boost/lexical_cast.hpp>
-#include <boost/bind.hpp>
 #include <boost/asio/io_service.hpp>
-#include <boost/asio/deadline_timer.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/asio/ip/udp.hpp>
 #include <boost/range.hpp>
 
 #include "udp_bus.hpp"
+#include "bus_packet.hpp"
 #include "spell.hpp"
 
 namespace brd { namespace bus {
 
 struct udp_bus::bus_impl {
     typedef boost::asio::io_service io_service;
-    typedef boost::asio::deadline_timer deadline_timer;
     typedef boost::asio::ip::udp udp;
     typedef boost::posix_time::time_duration time_duration;
 
-    enum command {
-        READMEM = 0x300,
-        WRITEMEM = 0x400
-    };
-
     bus_impl( const std::string& host,
               unsigned short port,
               time_duration timeout  = boost::posix_time::seconds(5) )
         : socket_(io_service_, udp::v4())
         , timeout_(timeout)
-        , deadline_(io_service_) {
+        , burst_(max_burst)
+        , depth_(8) {
         udp::resolver resolver(io_service_);
         udp::resolver::query query(udp::v4(), host, 
                                    boost::lexical_cast<std::string>(port));
         udp::endpoint endpoint = *resolver.resolve(query);
         socket_.connect(endpoint);
-        check_deadline();
         capture();
     }
 
     value_type read(const address& addr) { 
-        std::vector<value_type> request(8);
-        request[0] = 0x12344321;
-        request[1] = READMEM;
-        request[2] = addr.type();
-        request[3] = addr.value();
-        request[4] = sizeof(value_type);
-        request[5] = 0;
-        send(request);
-
-        std::vector<value_type> answer(9);
-        receive(answer);
-        return answer.back();
+        return read(make_header(READMEM, addr.type(), addr.value(), 1));
     }
 
     void write(const address& addr, value_type value) {
-        std::vector<value_type> request(9);
-        request[0] = 0x12344321;
-        request[1] = WRITEMEM;
-        request[2] = addr.type();
-        request[3] = addr.value();
-        request[4] = sizeof(value_type);
-        request[5] = 0;
-        request[8] = value;
+        write(make_header(WRITEMEM, addr.type(), addr.value(), 1), value);
+    }
+
+    value_type read(const packet_header& header) {
+        packet request;
+        request.encode(header);
+        socket_.send(boost::asio::buffer(&request, request.bytes(0)));
+
+        packet answer;
+        exchange(request, answer, answer.bytes(1));
+        value_type value;
+        answer.decode(&value, 1);
+        return value;
+    }
+
+    void write(const packet_header& header, value_type value) {
+        packet request;
+        request.encode(header, &value, 1);
+        socket_.send(boost::asio::buffer(&request, request.bytes(1)));
+
+        packet answer;
+        exchange(request, answer, answer.bytes(0));
+    }
+
+    void read_block(const address& addr, value_type* data, std::size_t count) {
+        transfer(READMEM, addr, 0, data, count);
+    }
+
+    void write_block(const address& addr, const value_type* data,
+                     std::size_t count) {
+        transfer(WRITEMEM, addr, data, 0, count);
+    }
+
+    void set_burst(std::size_t words, std::size_t depth) {
+        if (words == 0 || words > max_burst || depth == 0)
+            throw bus_error("bad burst configuration");
+        burst_ = words;
+        depth_ = depth;
+    }
+private:
+    // waits for the answer echoing the command and address of
+    // `request`, answers left over from an earlier request are skipped
+    void exchange(const packet& request, packet& answer,
+                  std::size_t expected) {
+        for (;;) {
+            boost::system::error_code ec;
+            std::size_t size = receive(boost::asio::buffer(&answer,
+                                                           sizeof(answer)),
+                                       timeout_, ec);
+            if (ec) {
+                throw timeout_error(ec.message());
+            }
+            if (size < answer.bytes(0) ||
+                answer.command() != request.command() ||
+                answer.address() != request.address())
+                continue; // stale answer
+            if (size != expected) {
+                throw bus_error("size error");
+            }
+            return;
+        }
+    }
+
+    // Keeps up to depth_ burst requests in flight, answers are matched
+    // to requests by the command and address they echo. Reads and
+    // writes of the same data are idempotent, so when an attempt times
+    // out the outstanding requests are sent again, up to
+    // transfer_retries times without progress.
+    void transfer(command cmd, const address& addr, const value_type* out,
+                  value_type* in, std::size_t count) {
+        const std::size_t chunks = (count + burst_ - 1)/burst_;
+        const uint32_t span = burst_*addr.step();
+        const time_duration attempt = timeout_/(transfer_retries + 1);
+        std::vector<bool> done(chunks);
+        std::size_t sent = 0;
+        std::size_t completed = 0;
+        std::size_t retries = 0;
+        packet answer;
+        while (completed < chunks) {
+            for (; sent < chunks && sent - completed < depth_; ++sent)
+                send_chunk(cmd, addr, sent, out, count);
+
+            boost::system::error_code ec;
+            std::size_t size = receive(boost::asio::buffer(&answer,
+                                                           sizeof(answer)),
+                                       attempt, ec);
+            if (ec == boost::asio::error::timed_out &&
+                retries < transfer_retries) {
+                ++retries;
+                for (std::size_t i = 0; i < sent; ++i)
+                    if (!done[i])
+                        send_chunk(cmd, addr, i, out, count);
+                continue;
+            }
+            if (ec) {
+                drain();
+                throw timeout_error(ec.message());
+            }
+            if (size < answer.bytes(0) || answer.command() != cmd)
+                continue; // stale answer
+
+            uint32_t offset = answer.address() - addr.value();
+            std::size_t chunk = offset/span;
+            if (offset%span || chunk >= chunks || done[chunk])
+                continue; // stale answer
+            std::size_t len = std::min(burst_, count - chunk*burst_);
+            if (size != answer.bytes(cmd == READMEM ? len : 0)) {
+                drain();
+                throw bus_error("size error");
+            }
+            if (cmd == READMEM)
+                answer.decode(in + chunk*burst_, len);
+            done[chunk] = true;
+            ++completed;
+            retries = 0;
+        }
+    }
 
-        send(request);
+    void send_chunk(command cmd, const address& addr, std::size_t chunk,
+                    const value_type* out, std::size_t count) {
+        std::size_t len = std::min(burst_, count - chunk*burst_);
+        packet_header header = make_header(cmd, addr.type(),
+                                           addr.value() +
+                                           chunk*burst_*addr.step(),
+                                           len);
+        packet request;
+        std::size_t words = 0;
+        if (cmd == WRITEMEM) {
+            request.encode(header, out + chunk*burst_, len);
+            words = len;
+        } else {
+            request.encode(header);
+        }
+        socket_.send(boost::asio::buffer(&request, request.bytes(words)));
+    }
 
-        std::vector<value_type> answer(8);
-        receive(answer);
+    // discards answers still queued, so that a failed transfer doesn't
+    // leave them to the next request
+    void drain() {
+        packet answer;
+        while (::recv(socket_.native_handle(), &answer, sizeof(answer),
+                      MSG_DONTWAIT) >= 0)
+            ;
     }
 private:
     void capture() {
@@ -105,42 +224,34 @@ private:
     }
 
 private:
-    void check_deadline() {
-        if (deadline_.expires_at() <= deadline_timer::traits_type::now()) {
-            socket_.cancel();
-            deadline_.expires_at(boost::posix_time::pos_infin);
-        }
-
-        deadline_.async_wait(boost::bind(&bus_impl::check_deadline, this));
-    }
-
+    // waits in poll(2) rather than on an asio deadline timer, that
+    // costs no allocation and no timer syscalls per request
     std::size_t receive( const boost::asio::mutable_buffer& buffer,
                          boost::posix_time::time_duration timeout,
                          boost::system::error_code& ec ) {
-        deadline_.expires_from_now(timeout);
-        ec = boost::asio::error::would_block;
-        std::size_t length = 0;
-
-        socket_.async_receive(boost::asio::buffer(buffer),
-                              boost::bind(&bus_impl::handle_receive, _1, _2,
-                                          &ec, &length));
-
-        do io_service_.run_one(); while (ec == boost::asio::error::would_block);
-        return length;
-    }
-
-    static void handle_receive(const boost::system::error_code& ec, 
-                               std::size_t length,
-                               boost::system::error_code* out_ec, 
-                               std::size_t* out_length) {
-        *out_ec = ec;
-        *out_length = length;
+        pollfd fd = { socket_.native_handle(), POLLIN, 0 };
+        int ready;
+        do ready = ::poll(&fd, 1, timeout.total_milliseconds());
+        while (ready < 0 && errno == EINTR);
+        if (ready == 0) {
+            ec = boost::asio::error::timed_out;
+            return 0;
+        }
+        if (ready < 0) {
+            ec = boost::system::error_code(errno,
+                                           boost::system::system_category());
+            return 0;
+        }
+        return socket_.receive(boost::asio::buffer(buffer), 0, ec);
     }
 private:
+    static const std::size_t transfer_retries = 4;
+
     static io_service io_service_;
     udp::socket socket_;
     time_duration timeout_;
-    deadline_timer deadline_;
+    std::size_t burst_;
+    std::size_t depth_;
 };
 
 
@@ -154,6 +265,23 @@ udp_bus::value_type udp_bus::read(const address& addr) {
 void udp_bus::write(const address& addr, value_type value) { 
     pimpl_->write(addr, value); 
 }
+udp_bus::value_type udp_bus::read(const packet_header& header) {
+    return pimpl_->read(header);
+}
+void udp_bus::write(const packet_header& header, value_type value) {
+    pimpl_->write(header, value);
+}
+void udp_bus::read_block(const address& addr, value_type* data,
+                         std::size_t count) {
+    pimpl_->read_block(addr, data, count);
+}
+void udp_bus::write_block(const address& addr, const value_type* data,
+                          std::size_t count) {
+    pimpl_->write_block(addr, data, count);
+}
+void udp_bus::set_burst(std::size_t words, std::size_t depth) {
+    pimpl_->set_burst(words, depth);
+}
 
 }} //namespace brd::bus
 
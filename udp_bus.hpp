@@ -3,13 +3,36 @@
 
 #include <boost/smart_ptr.hpp>
 #include "ibus.hpp"
+#include "bus_packet.hpp"
 
 namespace brd { namespace bus {
 
 struct udp_bus : ibus {
     explicit udp_bus(const std::string& host, unsigned short port = 3001);
+    using ibus::read;
+    using ibus::write;
     value_type read(const address&);
     void write(const address&, value_type);
+
+    // pre-encoded single word requests
+    value_type read(const packet_header& header);
+    void write(const packet_header& header, value_type value);
+
+    // typed register access, see b101e1ngu_regs.hpp
+    template <typename Register>
+    value_type read_register() { return read(Register::read_header); }
+
+    template <typename Register>
+    void write_register(value_type value) {
+        write(Register::write_header, value);
+    }
+
+    void read_block(const address& addr, value_type* data, std::size_t count);
+    void write_block(const address& addr, const value_type* data,
+                     std::size_t count);
+
+    // words per burst request and requests kept in flight
+    void set_burst(std::size_t words, std::size_t depth);
     struct bus_impl;
 private:
     boost::shared_ptr<bus_impl> pimpl_;